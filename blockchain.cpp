@@ -37,6 +37,7 @@ public:
         : transactionId(txId), outputIndex(index), amount(amt), ownerKey(owner) {}
 };
 
+template <typename Hash>
 class Transaction {
 private:
     std::string transactionId;
@@ -67,7 +68,7 @@ public:
         for (const auto& output : outputs) outputSum += output.amount;
         if (inputSum < outputSum) return false;
 
-        MyHash hasher;
+        Hash hasher;
         std::string data;
         for (const auto& input : inputs) {
             data += input.transactionId + std::to_string(input.outputIndex) + 
@@ -81,7 +82,7 @@ public:
     }
 
     void generateTransactionId() {
-        MyHash hasher;
+        Hash hasher;
         std::string data;
         // Combine all inputs
         for (const auto& input : inputs) {
@@ -128,14 +129,16 @@ public:
     const std::vector<UTXO>& getOutputs() const { return outputs; }
 };
 
+template <typename Hash>
 class Block {
 private:
     std::string previousHash;
-    std::vector<Transaction> transactions;
+    std::vector<Transaction<Hash>> transactions;
     std::string merkleRoot;
     int nonce;
     std::string blockHash;
     int blockHeight;
+    long long hashCount;
     std::chrono::system_clock::time_point timestamp;
 
     MerkleNode* buildMerkleTree(const std::vector<std::string>& leaves) {
@@ -146,17 +149,26 @@ private:
             nodes.push_back(new MerkleNode(leaf));
         }
         
+        Hash hasher;
         while (nodes.size() > 1) {
+            // Hash the whole level in one call so batching policies can fill their lanes
+            std::vector<std::string> combined;
+            for (size_t i = 0; i < nodes.size(); i += 2) {
+                MerkleNode* right = (i + 1 < nodes.size()) ? nodes[i + 1] : nodes[i];
+                combined.push_back(nodes[i]->hash + right->hash);
+            }
+            std::vector<std::string> combinedHashes(combined.size());
+            hasher.generateHashes(combined.data(), combinedHashes.data(), combined.size());
+
             std::vector<MerkleNode*> newLevel;
             for (size_t i = 0; i < nodes.size(); i += 2) {
                 MerkleNode* left = nodes[i];
                 MerkleNode* right = (i + 1 < nodes.size()) ? nodes[i + 1] : nodes[i];
-                
-                MyHash hasher;
-                std::string combinedHash = hasher.generateHash(left->hash + right->hash);
-                MerkleNode* parent = new MerkleNode(combinedHash);
+
+                MerkleNode* parent = new MerkleNode(combinedHashes[i / 2]);
                 parent->left = left;
-                parent->right = right;
+                // An odd node is paired with itself; only own it once
+                parent->right = (right != left) ? right : nullptr;
                 newLevel.push_back(parent);
             }
             nodes = newLevel;
@@ -167,11 +179,11 @@ private:
 
 public:
     Block(const std::string& prevHash, int height)
-        : previousHash(prevHash), nonce(0), blockHeight(height) {
+        : previousHash(prevHash), nonce(0), blockHeight(height), hashCount(0) {
         timestamp = std::chrono::system_clock::now();
     }
 
-    void addTransaction(const Transaction& tx) {
+    void addTransaction(const Transaction<Hash>& tx) {
         transactions.push_back(tx);
         calculateMerkleRoot();
     }
@@ -192,17 +204,24 @@ public:
     }
 
     bool mineBlock(int difficulty, int timeLimit) {
-        MyHash hasher;
+        Hash hasher;
+        const int lanes = Hash::batchSize;  // Nonces hashed per generateHashes() call
         std::string target(difficulty, '0');
+        const std::string prefix = previousHash + merkleRoot;
+        const std::string suffix = std::to_string(std::chrono::system_clock::to_time_t(timestamp));
         auto startTime = std::chrono::steady_clock::now();
         bool found = false;
         int nonceCounter = 0;
         std::atomic<bool> shouldExit{false};  // Atomic flag for coordinating thread exit
+        std::atomic<long long> totalHashes{0};
         
         #pragma omp parallel
         {
-            std::string localBlockHash;
+            std::vector<std::string> data(lanes);
+            std::vector<std::string> localBlockHashes(lanes);
+            long long localHashes = 0;
             int localNonce;
+            int rangeEnd;
             
             // Each thread gets its own nonce range
             #pragma omp critical
@@ -210,6 +229,7 @@ public:
                 localNonce = nonceCounter;
                 nonceCounter += 1000000;  // Increment by a large step to give each thread its own range
             }
+            rangeEnd = localNonce + 1000000;
             
             while (true) {
                 // Check time limit
@@ -227,41 +247,50 @@ public:
                 if (found) {
                     break;
                 }
-                // Create block data with current nonce
-                std::string data = previousHash + merkleRoot +
-                                std::to_string(localNonce) +
-                                std::to_string(std::chrono::system_clock::to_time_t(timestamp));
+                // Create block data for the next batch of nonces, never past the end of our range
+                int batch = std::min(lanes, rangeEnd - localNonce);
+                for (int lane = 0; lane < batch; lane++) {
+                    data[lane] = prefix + std::to_string(localNonce + lane) + suffix;
+                }
                 
-                // Generate and check hash
-                localBlockHash = hasher.generateHash(data);
-                if (localBlockHash.substr(0, difficulty) == target) {
+                // Generate and check hashes
+                hasher.generateHashes(data.data(), localBlockHashes.data(), batch);
+                localHashes += batch;
+                int hit = -1;
+                for (int lane = 0; lane < batch && hit < 0; lane++) {
+                    if (localBlockHashes[lane].compare(0, difficulty, target) == 0) hit = lane;
+                }
+                if (hit >= 0) {
                     #pragma omp critical
                     {
                         if (!found) {
                             found = true;
-                            nonce = localNonce;
-                            blockHash = localBlockHash;
+                            nonce = localNonce + hit;
+                            blockHash = localBlockHashes[hit];
                             shouldExit = true;  // Signal other threads to exit
                         }
                     }
                     break;
                 }
                 
-                localNonce++;
+                localNonce += batch;
                 
-                if (localNonce % 1000000 == 0) {
+                if (localNonce == rangeEnd) {
                     #pragma omp critical
                     {
                         localNonce = nonceCounter;
                         nonceCounter += 1000000;
                     }
+                    rangeEnd = localNonce + 1000000;
                 }
             }
             // auto endTime = std::chrono::steady_clock::now();
             // auto elapsedTime = std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime).count();
             // std::cout << elapsedTime ;
+            totalHashes += localHashes;
         }
 
+        hashCount = totalHashes;
         return found;
     }
 
@@ -290,20 +319,22 @@ public:
         std::cout << buffer.str();
     }
 
-    const std::vector<Transaction>& getTransactions() const { return transactions; }
+    const std::vector<Transaction<Hash>>& getTransactions() const { return transactions; }
     std::string getHash() const { return blockHash; }
+    long long getHashCount() const { return hashCount; }
 };
 
+template <typename Hash>
 class Blockchain {
 private:
-    std::vector<Block> chain;
-    std::vector<Transaction> pendingTransactions;
+    std::vector<Block<Hash>> chain;
+    std::vector<Transaction<Hash>> pendingTransactions;
     std::vector<User> users;
     int difficulty;
     std::vector<UTXO> utxoPool;
     
     std::string generatePublicKey() {
-        MyHash hasher;
+        Hash hasher;
         static int counter = 0;
         return hasher.generateHash("user" + std::to_string(counter++));
     }
@@ -321,7 +352,7 @@ private:
 public:
     Blockchain(int diff = 5) : difficulty(diff) {
         // Create genesis block
-        Block genesisBlock("0", 0);
+        Block<Hash> genesisBlock("0", 0);
         genesisBlock.mineBlock(difficulty, 1);
         chain.push_back(genesisBlock);
     }
@@ -397,7 +428,7 @@ public:
                     outputs.emplace_back("", outputIndex++, change, senderKey);
                 }
                 
-                Transaction tx(selectedInputs, outputs);
+                Transaction<Hash> tx(selectedInputs, outputs);
                 pendingTransactions.push_back(tx);
             }
             else if (isAvailableUtxos(availableUtxos)) i--;
@@ -416,7 +447,7 @@ public:
         return count == unavailable ? false : true;
     }
 
-    void updateUTXOPool(const Transaction& tx) {
+    void updateUTXOPool(const Transaction<Hash>& tx) {
         for (const auto& input : tx.getInputs()) {
             utxoPool.erase(
                 std::remove_if(utxoPool.begin(), utxoPool.end(),
@@ -433,12 +464,12 @@ public:
         if (pendingTransactions.empty()) return;
 
         // Create 5 candidate blocks
-        std::vector<Block> candidates;
+        std::vector<Block<Hash>> candidates;
         std::random_device rd;
         std::mt19937 gen(rd());
 
         for (int i = 0; i < 5; i++) {
-            Block candidate(chain.back().getHash(), chain.size());
+            Block<Hash> candidate(chain.back().getHash(), chain.size());
             
             // Select ~100 random transactions
             std::vector<int> indices(pendingTransactions.size());
@@ -448,7 +479,7 @@ public:
             int txCount = std::min(100, static_cast<int>(pendingTransactions.size()));
             for (int j = 0; j < txCount; j++) {
                 // cout << j << " " << indices[j] << endl;
-                const Transaction& tx = pendingTransactions[indices[j]];
+                const Transaction<Hash>& tx = pendingTransactions[indices[j]];
                 if (tx.verifyTransaction(utxoPool)) {
                     candidate.addTransaction(tx);
                 }
@@ -470,7 +501,7 @@ public:
                 for (const auto& tx : transactions) {
                     pendingTransactions.erase(
                         std::remove_if(pendingTransactions.begin(), pendingTransactions.end(),
-                            [&tx](const Transaction& t) { return t.getId() == tx.getId(); }),
+                            [&tx](const Transaction<Hash>& t) { return t.getId() == tx.getId(); }),
                         pendingTransactions.end());
                 }
 
@@ -524,7 +555,7 @@ public:
         }
     }
 
-    const std::vector<Transaction>& getPendingTransactions() const {
+    const std::vector<Transaction<Hash>>& getPendingTransactions() const {
         return pendingTransactions;
     }
 
@@ -549,10 +580,58 @@ public:
     }
 };
 
-int main() {
-    std::ios::sync_with_stdio(false);
+template <typename Hash>
+void benchmarkHashPolicy() {
+    const int txCount = 256;
+    const int merkleRounds = 200;
+    const int miningSeconds = 2;
+    Hash hasher;
+
+    Block<Hash> block(hasher.generateHash("benchmark"), 1);
+    for (int i = 0; i < txCount; i++) {
+        std::string owner = hasher.generateHash("owner" + std::to_string(i));
+        std::vector<UTXO> inputs{UTXO(hasher.generateHash("input" + std::to_string(i)), 0, 100.0, owner)};
+        std::vector<UTXO> outputs{UTXO("", 0, 100.0, owner)};
+        block.addTransaction(Transaction<Hash>(inputs, outputs));
+    }
+
+    // Merkle: internal nodes hashed per root for txCount leaves
+    long long merkleHashes = 0;
+    for (int level = txCount; level > 1; level = (level + 1) / 2) merkleHashes += (level + 1) / 2;
+
+    auto merkleStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < merkleRounds; i++) {
+        block.calculateMerkleRoot();
+    }
+    double merkleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - merkleStart).count();
 
-    Blockchain blockchain(5); 
+    // Mining: a target no hash can meet keeps every thread busy for the whole time limit
+    auto miningStart = std::chrono::steady_clock::now();
+    block.mineBlock(64, miningSeconds);
+    double minedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - miningStart).count();
+
+    std::cout << Hash::name() << ":\n";
+    std::cout << "  Mining: " << static_cast<long long>(block.getHashCount() / minedSeconds) << " H/s\n";
+    std::cout << "  Merkle (" << txCount << " leaves): " << static_cast<long long>(merkleRounds / merkleSeconds)
+              << " roots/s, " << static_cast<long long>(merkleRounds * merkleHashes / merkleSeconds) << " H/s\n";
+}
+
+void benchmarkHashPolicies() {
+    std::cout << "\n=== Hash Policy Benchmark ===\n";
+    std::cout << "SHA-256 backend: " << Sha256Hash::backend() << "\n";
+    std::cout << "SHA-256 self-check:";
+    for (const auto& result : Sha256Hash::selfCheck()) {
+        std::cout << " " << result.backend << " "
+                  << (!result.supported ? "skipped" : result.passed ? "pass" : "FAIL");
+    }
+    std::cout << "\n";
+    benchmarkHashPolicy<MyHash>();
+    benchmarkHashPolicy<Sha256Hash>();
+}
+
+template <typename Hash>
+int runBlockchain() {
+    Blockchain<Hash> blockchain(5); 
 
     // Generate initial users and transactions
     blockchain.createUsers(1000);
@@ -561,7 +640,7 @@ int main() {
 
     while (true) {
         std::string command;
-        std::cout << "\nEnter command (mine/mine_all/info/balances/utxo/new_user <number>/new_transaction <number>/transaction <transactionID>/block <blockIdx>/exit): ";
+        std::cout << "\nEnter command (mine/mine_all/info/balances/utxo/new_user <number>/new_transaction <number>/transaction <transactionID>/block <blockIdx>/benchmark/exit): ";
         std::cin >> command;
 
         if (command == "mine") {
@@ -601,6 +680,9 @@ int main() {
             std::cin >> blockIndex;
             blockchain.printBlockInfo(blockIndex);
         }
+        else if (command == "benchmark") {
+            benchmarkHashPolicies();
+        }
         else if (command == "exit") {
             break;
         }
@@ -608,3 +690,18 @@ int main() {
 
     return 0;
 }
+
+
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "benchmark") {
+        benchmarkHashPolicies();
+        return 0;
+    }
+    if (mode == "sha256") {
+        return runBlockchain<Sha256Hash>();
+    }
+    return runBlockchain<MyHash>();
+}
\ No newline at end of file
@@ -1,19 +1,24 @@
 #pragma GCC optimize("O3,unroll-loops")
-#pragma GCC target("avx2")
 #include <bits/stdc++.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HASH_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
-class hashingGenerator
-{
-public:
-    virtual string generateHash(string key) = 0;
-
-};
+// Hash policies are plugged into Block/Transaction/Blockchain as a template
+// parameter, so every call is resolved at compile time (no virtual dispatch).
+// A policy provides:
+//   static const char* name();
+//   static const size_t batchSize;   - how many messages generateHashes() prefers
+//   string generateHash(const string& key) const;
+//   void generateHashes(const string* keys, string* out, size_t count) const;
 
-class MyHash : hashingGenerator
+class MyHash
 {
-    uint64_t mix(uint64_t value, int shift)
+    static uint64_t mix(uint64_t value, int shift)
     {
         value ^= (value >> shift);
         value *= 0x7FFFFFFF;
@@ -21,7 +26,10 @@ class MyHash : hashingGenerator
         return value;
     }
 public :
-    string generateHash(string key)
+    static const size_t batchSize = 1;
+    static const char* name() { return "MyHash"; }
+
+    string generateHash(const string& key) const
     {
         int length = key.size();
         const uint8_t* data = reinterpret_cast<const uint8_t*>(key.data());
@@ -59,4 +67,418 @@ public :
         snprintf(result, 65, "%016llx%016llx%016llx%016llx", h1, h2, h3, h4);
         return string(result);
     }
+
+    void generateHashes(const string* keys, string* out, size_t count) const
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = generateHash(keys[i]);
+    }
+};
+
+namespace sha256_detail
+{
+    static const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    static const uint32_t H0[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    inline uint32_t loadBE(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    // Number of 64-byte blocks after padding (0x80 byte + 64-bit length).
+    inline size_t paddedBlocks(size_t length) { return (length + 9 + 63) / 64; }
+
+    // Padded messages up to this many blocks are built on the stack; mining and
+    // Merkle inputs (two 64-char hashes plus a little) need at most 3.
+    static const size_t stackBlocks = 4;
+
+    // Appends SHA-256 padding to message into buf (sized paddedBlocks * 64).
+    inline void pad(const string& message, uint8_t* buf)
+    {
+        size_t length = message.size();
+        size_t total = paddedBlocks(length) * 64;
+        memcpy(buf, message.data(), length);
+        buf[length] = 0x80;
+        memset(buf + length + 1, 0, total - length - 1);
+        uint64_t bits = uint64_t(length) * 8;
+        for (int i = 0; i < 8; i++)
+            buf[total - 1 - i] = uint8_t(bits >> (8 * i));
+    }
+
+    inline string toHex(const uint32_t state[8])
+    {
+        static const char digits[] = "0123456789abcdef";
+        string result(64, '0');
+        for (int i = 0; i < 8; i++)
+            for (int j = 0; j < 8; j++)
+                result[i * 8 + j] = digits[(state[i] >> (28 - 4 * j)) & 0xF];
+        return result;
+    }
+
+    inline void compressScalar(uint32_t state[8], const uint8_t* data, size_t blocks)
+    {
+        uint32_t w[64];
+        for (; blocks > 0; blocks--, data += 64)
+        {
+            for (int i = 0; i < 16; i++)
+                w[i] = loadBE(data + 4 * i);
+            for (int i = 16; i < 64; i++)
+            {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; i++)
+            {
+                uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+    }
+
+#ifdef HASH_X86
+    struct CpuFeatures
+    {
+        bool sha;
+        bool avx2;
+
+        CpuFeatures() : sha(false), avx2(false)
+        {
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return;
+            bool sse41 = (ecx & bit_SSE4_1) != 0;
+            bool ssse3 = (ecx & bit_SSSE3) != 0;
+            // AVX state must be enabled by the OS (OSXSAVE + XCR0 bits 1 and 2).
+            bool osAvx = false;
+            if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX))
+            {
+                unsigned int xcr0, xcr0High;
+                __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+                osAvx = (xcr0 & 6) == 6;
+            }
+            if (__get_cpuid_max(0, nullptr) < 7) return;
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            sha = (ebx & bit_SHA) && sse41 && ssse3;
+            avx2 = (ebx & bit_AVX2) && osAvx;
+        }
+    };
+
+    inline const CpuFeatures& cpu()
+    {
+        static const CpuFeatures features;
+        return features;
+    }
+
+    __attribute__((target("sha,sse4.1,ssse3")))
+    inline void compressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks)
+    {
+        const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+        __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+        __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+        tmp = _mm_shuffle_epi32(tmp, 0xB1);            // CDAB
+        state1 = _mm_shuffle_epi32(state1, 0x1B);      // EFGH
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);   // CDGH
+
+        for (; blocks > 0; blocks--, data += 64)
+        {
+            __m128i abefSave = state0;
+            __m128i cdghSave = state1;
+            __m128i w[4];
+            for (int g = 0; g < 16; g++)
+            {
+                if (g < 4)
+                {
+                    w[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * g)), MASK);
+                }
+                else
+                {
+                    // w[g] = msg2(msg1(w[g-4], w[g-3]) + (w[g-2]:w[g-1] >> 32), w[g-1])
+                    __m128i t = _mm_sha256msg1_epu32(w[g & 3], w[(g + 1) & 3]);
+                    t = _mm_add_epi32(t, _mm_alignr_epi8(w[(g + 3) & 3], w[(g + 2) & 3], 4));
+                    w[g & 3] = _mm_sha256msg2_epu32(t, w[(g + 3) & 3]);
+                }
+                __m128i msg = _mm_add_epi32(w[g & 3], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * g])));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+                msg = _mm_shuffle_epi32(msg, 0x0E);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            }
+            state0 = _mm_add_epi32(state0, abefSave);
+            state1 = _mm_add_epi32(state1, cdghSave);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);         // FEBA
+        state1 = _mm_shuffle_epi32(state1, 0xB1);      // DCHG
+        state0 = _mm_blend_epi16(tmp, state1, 0xF0);   // DCBA
+        state1 = _mm_alignr_epi8(state1, tmp, 8);      // HGFE
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+    }
+
+    // Eight independent messages of equal padded length, one per 32-bit lane.
+    __attribute__((target("avx2")))
+    inline void compress8Avx2(uint32_t state[8][8], const uint8_t* const data[8], size_t blocks)
+    {
+#define SHA_ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+        __m256i s[8];
+        for (int i = 0; i < 8; i++)
+            s[i] = _mm256_setr_epi32(state[0][i], state[1][i], state[2][i], state[3][i],
+                                     state[4][i], state[5][i], state[6][i], state[7][i]);
+
+        __m256i w[64];
+        for (size_t block = 0; block < blocks; block++)
+        {
+            size_t offset = block * 64;
+            for (int i = 0; i < 16; i++)
+            {
+                size_t at = offset + 4 * i;
+                w[i] = _mm256_setr_epi32(loadBE(data[0] + at), loadBE(data[1] + at), loadBE(data[2] + at),
+                                         loadBE(data[3] + at), loadBE(data[4] + at), loadBE(data[5] + at),
+                                         loadBE(data[6] + at), loadBE(data[7] + at));
+            }
+            for (int i = 16; i < 64; i++)
+            {
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(SHA_ROTR8(w[i - 15], 7), SHA_ROTR8(w[i - 15], 18)),
+                                              _mm256_srli_epi32(w[i - 15], 3));
+                __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(SHA_ROTR8(w[i - 2], 17), SHA_ROTR8(w[i - 2], 19)),
+                                              _mm256_srli_epi32(w[i - 2], 10));
+                w[i] = _mm256_add_epi32(_mm256_add_epi32(w[i - 16], s0), _mm256_add_epi32(w[i - 7], s1));
+            }
+
+            __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+            __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+            for (int i = 0; i < 64; i++)
+            {
+                __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(SHA_ROTR8(e, 6), SHA_ROTR8(e, 11)), SHA_ROTR8(e, 25));
+                __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+                __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sigma1),
+                                              _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32(K[i])), w[i]));
+                __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(SHA_ROTR8(a, 2), SHA_ROTR8(a, 13)), SHA_ROTR8(a, 22));
+                __m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+                                               _mm256_and_si256(b, c));
+                __m256i t2 = _mm256_add_epi32(sigma0, maj);
+                h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);
+                d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+            }
+            s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+            s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+            s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+            s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+            alignas(32) uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), s[i]);
+            for (int lane = 0; lane < 8; lane++)
+                state[lane][i] = lanes[lane];
+        }
+#undef SHA_ROTR8
+    }
+#endif
+
+    inline void compress(uint32_t state[8], const uint8_t* data, size_t blocks)
+    {
+#ifdef HASH_X86
+        if (cpu().sha)
+        {
+            compressShaNi(state, data, blocks);
+            return;
+        }
+#endif
+        compressScalar(state, data, blocks);
+    }
+
+    enum Backend { SCALAR, SHA_NI, AVX2 };
+
+    inline bool supported(Backend backend)
+    {
+#ifdef HASH_X86
+        if (backend == SHA_NI) return cpu().sha;
+        if (backend == AVX2) return cpu().avx2;
+#endif
+        return backend == SCALAR;
+    }
+
+    // Hashes eight messages of equal padded length with the given backend,
+    // bypassing the runtime selection. Only call it if supported(backend).
+    inline void hash8With(Backend backend, const string messages[8], string out[8])
+    {
+        size_t blocks = paddedBlocks(messages[0].size());
+        vector<uint8_t> buf(8 * blocks * 64);
+        const uint8_t* lanes[8];
+        uint32_t state[8][8];
+        for (int j = 0; j < 8; j++)
+        {
+            pad(messages[j], buf.data() + j * blocks * 64);
+            lanes[j] = buf.data() + j * blocks * 64;
+            memcpy(state[j], H0, sizeof(state[j]));
+        }
+#ifdef HASH_X86
+        if (backend == AVX2)
+            compress8Avx2(state, lanes, blocks);
+        for (int j = 0; j < 8 && backend == SHA_NI; j++)
+            compressShaNi(state[j], lanes[j], blocks);
+#endif
+        for (int j = 0; j < 8 && backend == SCALAR; j++)
+            compressScalar(state[j], lanes[j], blocks);
+        for (int j = 0; j < 8; j++)
+            out[j] = toHex(state[j]);
+    }
+}
+
+// Standard SHA-256. Single messages use SHA-NI when available, batches of
+// eight equally sized messages use the AVX2 multi-buffer path on CPUs without
+// SHA-NI; everything else falls back to the portable scalar code.
+class Sha256Hash
+{
+public :
+    static const size_t batchSize = 8;
+    static const char* name() { return "SHA-256"; }
+
+    static const char* backend()
+    {
+#ifdef HASH_X86
+        if (sha256_detail::cpu().sha) return "SHA-NI";
+        if (sha256_detail::cpu().avx2) return "AVX2 x8";
+#endif
+        return "scalar";
+    }
+
+    struct SelfCheckResult
+    {
+        const char* backend;
+        bool supported;
+        bool passed;
+    };
+
+    // Known-answer test of every backend, not just the one backend() picks,
+    // so a broken fallback shows up on any machine that can run it.
+    static vector<SelfCheckResult> selfCheck()
+    {
+        static const char* abc = "abc";
+        static const char* twoBlock56 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+        static const char* twoBlock112 = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+                                         "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+        static const char* abcHash = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+        static const char* twoBlock56Hash = "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1";
+        static const char* twoBlock112Hash = "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1";
+
+        // One batch of a single block length, one mixing two messages so lanes must stay independent
+        string single[8], mixed[8], expected[2][8];
+        for (int j = 0; j < 8; j++)
+        {
+            single[j] = abc;
+            expected[0][j] = abcHash;
+            mixed[j] = (j % 2) ? twoBlock112 : twoBlock56;
+            expected[1][j] = (j % 2) ? twoBlock112Hash : twoBlock56Hash;
+        }
+
+        static const sha256_detail::Backend backends[] = {
+            sha256_detail::SCALAR, sha256_detail::SHA_NI, sha256_detail::AVX2
+        };
+        static const char* names[] = { "scalar", "SHA-NI", "AVX2 x8" };
+        vector<SelfCheckResult> results;
+        for (int b = 0; b < 3; b++)
+        {
+            SelfCheckResult result = { names[b], sha256_detail::supported(backends[b]), false };
+            if (result.supported)
+            {
+                string out[8];
+                result.passed = true;
+                sha256_detail::hash8With(backends[b], single, out);
+                for (int j = 0; j < 8; j++) result.passed = result.passed && out[j] == expected[0][j];
+                sha256_detail::hash8With(backends[b], mixed, out);
+                for (int j = 0; j < 8; j++) result.passed = result.passed && out[j] == expected[1][j];
+            }
+            results.push_back(result);
+        }
+        return results;
+    }
+
+    string generateHash(const string& key) const
+    {
+        size_t blocks = sha256_detail::paddedBlocks(key.size());
+        uint8_t stackBuf[sha256_detail::stackBlocks * 64];
+        vector<uint8_t> heapBuf;
+        uint8_t* buf = stackBuf;
+        if (blocks > sha256_detail::stackBlocks)
+        {
+            heapBuf.resize(blocks * 64);
+            buf = heapBuf.data();
+        }
+        sha256_detail::pad(key, buf);
+
+        uint32_t state[8];
+        memcpy(state, sha256_detail::H0, sizeof(state));
+        sha256_detail::compress(state, buf, blocks);
+        return sha256_detail::toHex(state);
+    }
+
+    void generateHashes(const string* keys, string* out, size_t count) const
+    {
+        size_t i = 0;
+#ifdef HASH_X86
+        if (!sha256_detail::cpu().sha && sha256_detail::cpu().avx2)
+        {
+            uint8_t stackBuf[8 * sha256_detail::stackBlocks * 64];
+            vector<uint8_t> heapBuf;
+            for (; i + 8 <= count; i += 8)
+            {
+                size_t blocks = sha256_detail::paddedBlocks(keys[i].size());
+                bool sameLength = true;
+                for (size_t j = 1; j < 8 && sameLength; j++)
+                    sameLength = sha256_detail::paddedBlocks(keys[i + j].size()) == blocks;
+                if (!sameLength)
+                {
+                    for (size_t j = 0; j < 8; j++)
+                        out[i + j] = generateHash(keys[i + j]);
+                    continue;
+                }
+
+                uint8_t* buf = stackBuf;
+                if (blocks > sha256_detail::stackBlocks)
+                {
+                    heapBuf.resize(8 * blocks * 64);
+                    buf = heapBuf.data();
+                }
+                const uint8_t* lanes[8];
+                uint32_t state[8][8];
+                for (size_t j = 0; j < 8; j++)
+                {
+                    uint8_t* lane = buf + j * blocks * 64;
+                    sha256_detail::pad(keys[i + j], lane);
+                    lanes[j] = lane;
+                    memcpy(state[j], sha256_detail::H0, sizeof(state[j]));
+                }
+                sha256_detail::compress8Avx2(state, lanes, blocks);
+                for (size_t j = 0; j < 8; j++)
+                    out[i + j] = sha256_detail::toHex(state[j]);
+            }
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = generateHash(keys[i]);
+    }
 };